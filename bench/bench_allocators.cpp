@@ -0,0 +1,69 @@
+#include "binary_heap.hpp"
+#include "fibonacci_heap.hpp"
+#include "catch2/catch.hpp"
+#include "bench_util.hpp"
+#include <array>
+#include <memory_resource>
+
+namespace {
+    const int requestCount = 100;
+    const int queueSize = 256;
+
+    // A request fills a short-lived queue, drains half of it and drops it.
+    template <class Heap>
+    long long serveRequest(Heap& heap, const std::vector<int>& values) {
+        for (int value : values) {
+            heap.push(value);
+        }
+        long long sum = 0;
+        for (size_t i = 0; i < values.size() / 2; ++i) {
+            sum += heap.peek();
+            heap.pop();
+        }
+        return sum;
+    }
+}
+
+TEST_CASE("request lifecycle with default and arena allocation", "[!benchmark][allocators]") {
+    const std::vector<int> values = randomValues(queueSize);
+
+    BENCHMARK("BinaryHeap, std::allocator") {
+        long long sum = 0;
+        for (int request = 0; request < requestCount; ++request) {
+            BinaryHeap<int> heap;
+            sum += serveRequest(heap, values);
+        }
+        return sum;
+    };
+
+    BENCHMARK("BinaryHeap, per-request arena") {
+        long long sum = 0;
+        for (int request = 0; request < requestCount; ++request) {
+            std::array<std::byte, 16 * 1024> buffer;
+            std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+            pmr::BinaryHeap<int> heap(&arena);
+            sum += serveRequest(heap, values);
+        }
+        return sum;
+    };
+
+    BENCHMARK("FibonacciHeap, std::allocator") {
+        long long sum = 0;
+        for (int request = 0; request < requestCount; ++request) {
+            FibonacciHeap<int> heap;
+            sum += serveRequest(heap, values);
+        }
+        return sum;
+    };
+
+    BENCHMARK("FibonacciHeap, per-request arena") {
+        long long sum = 0;
+        for (int request = 0; request < requestCount; ++request) {
+            std::array<std::byte, 64 * 1024> buffer;
+            std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+            pmr::FibonacciHeap<int> heap(&arena);
+            sum += serveRequest(heap, values);
+        }
+        return sum;
+    };
+}
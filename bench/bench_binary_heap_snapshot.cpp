@@ -0,0 +1,76 @@
+#include "binary_heap.hpp"
+#include "catch2/catch.hpp"
+#include "bench_util.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    const size_t elementCount = 2000000;
+
+    std::vector<int> readSnapshotElements(const std::string& path) {
+        // skips the snapshot header, like a restore that does not know about mapFrom would
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        size_t bytes = static_cast<size_t>(file.tellg()) - 64;
+        std::vector<int> values(bytes / sizeof(int));
+        file.seekg(64);
+        file.read(reinterpret_cast<char*>(values.data()), bytes);
+        return values;
+    }
+}
+
+TEST_CASE("restoring a saved heap", "[!benchmark][binary_heap]") {
+    const std::string path = (std::filesystem::temp_directory_path() / "wiki_structs_bench.snapshot").string();
+
+    {
+        BinaryHeap<int> heap;
+        for (int value : randomValues(elementCount)) {
+            heap.push(value);
+        }
+        heap.save(path);
+    }
+
+    // restores are followed by the same small amount of work, so lazily mapped pages are paid for too
+    auto drain = [](BinaryHeap<int>& heap) {
+        long long sum = 0;
+        for (int i = 0; i < 1000; ++i) {
+            sum += heap.peek();
+            heap.pop();
+        }
+        return sum;
+    };
+
+    BENCHMARK("re-push every element") {
+        std::vector<int> values = readSnapshotElements(path);
+        BinaryHeap<int> heap;
+        for (int value : values) {
+            heap.push(value);
+        }
+        return drain(heap);
+    };
+
+    BENCHMARK("heapify") {
+        std::vector<int> values = readSnapshotElements(path);
+        BinaryHeap<int> heap(values.begin(), values.end());
+        return drain(heap);
+    };
+
+    BENCHMARK("mapFrom read-only") {
+        BinaryHeap<int> heap;
+        heap.mapFrom(path, MappedFile::Mode::ReadOnly);
+        return heap.peek();
+    };
+
+    BENCHMARK("mapFrom read-only, then modified") {
+        BinaryHeap<int> heap;
+        heap.mapFrom(path, MappedFile::Mode::ReadOnly);
+        return drain(heap);
+    };
+
+    BENCHMARK("mapFrom copy-on-write") {
+        BinaryHeap<int> heap;
+        heap.mapFrom(path, MappedFile::Mode::CopyOnWrite);
+        return drain(heap);
+    };
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,112 @@
+#include "fibonacci_heap.hpp"
+#include "catch2/catch.hpp"
+#include <limits>
+#include <memory_resource>
+#include <random>
+
+namespace {
+    struct Edge {
+        int to;
+        long weight;
+    };
+
+    typedef std::vector<std::vector<Edge>> Graph;
+
+    // Preferential attachment (Barabasi-Albert): a few hubs end up with very high degree.
+    Graph powerLawGraph(int vertexCount, int edgesPerVertex) {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<long> weight(1, 1000);
+        Graph graph(vertexCount);
+        std::vector<int> endpoints;
+
+        for (int v = 1; v <= edgesPerVertex; ++v) {
+            graph[0].push_back({v, weight(gen)});
+            graph[v].push_back({0, weight(gen)});
+            endpoints.push_back(0);
+            endpoints.push_back(v);
+        }
+        for (int v = edgesPerVertex + 1; v < vertexCount; ++v) {
+            for (int e = 0; e < edgesPerVertex; ++e) {
+                int u = endpoints[gen() % endpoints.size()];
+                long w = weight(gen);
+                graph[v].push_back({u, w});
+                graph[u].push_back({v, w});
+                endpoints.push_back(u);
+                endpoints.push_back(v);
+            }
+        }
+        return graph;
+    }
+
+    struct Entry {
+        long distance;
+        int vertex;
+
+        bool operator<(const Entry& rhs) const {
+            return distance < rhs.distance;
+        }
+    };
+
+    typedef pmr::FibonacciHeap<Entry> Heap;
+
+    template <bool batched>
+    long dijkstra(const Graph& graph) {
+        // nodes are reclaimed all at once with the arena
+        std::pmr::monotonic_buffer_resource arena;
+        Heap heap(&arena);
+
+        std::vector<Heap::NodeHandle> handles(graph.size());
+        std::vector<long> distances(graph.size(), std::numeric_limits<long>::max());
+        std::vector<bool> done(graph.size(), false);
+        std::vector<std::pair<Heap::NodeHandle, Entry>> updates;
+
+        distances[0] = 0;
+        handles[0] = heap.push(Entry{0, 0});
+        while (!heap.empty()) {
+            Entry top = heap.peek();
+            heap.pop();
+            done[top.vertex] = true;
+
+            updates.clear();
+            for (const Edge& edge : graph[top.vertex]) {
+                long distance = top.distance + edge.weight;
+                if (done[edge.to] || distance >= distances[edge.to]) {
+                    continue;
+                }
+
+                bool queued = distances[edge.to] != std::numeric_limits<long>::max();
+                distances[edge.to] = distance;
+                if (!queued) {
+                    handles[edge.to] = heap.push(Entry{distance, edge.to});
+                } else if (batched) {
+                    updates.emplace_back(handles[edge.to], Entry{distance, edge.to});
+                } else {
+                    heap.decreaseKey(handles[edge.to], Entry{distance, edge.to});
+                }
+            }
+            if (batched) {
+                heap.decreaseKeys(updates);
+            }
+        }
+
+        long sum = 0;
+        for (long distance : distances) {
+            sum += distance;
+        }
+        return sum;
+    }
+}
+
+TEST_CASE("dijkstra on a power-law graph", "[!benchmark][fibonacci_heap]") {
+    const Graph graph = powerLawGraph(50000, 8);
+
+    REQUIRE( dijkstra<false>(graph) == dijkstra<true>(graph) );
+
+    BENCHMARK("decreaseKey per edge") {
+        return dijkstra<false>(graph);
+    };
+
+    BENCHMARK("decreaseKeys per vertex") {
+        return dijkstra<true>(graph);
+    };
+}
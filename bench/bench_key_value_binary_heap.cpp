@@ -0,0 +1,53 @@
+#include "binary_heap.hpp"
+#include "key_value_binary_heap.hpp"
+#include "catch2/catch.hpp"
+#include "bench_util.hpp"
+#include <array>
+
+namespace {
+    template <size_t N>
+    struct Payload {
+        std::array<char, N> bytes;
+    };
+
+    template <size_t N>
+    struct Entry {
+        int key;
+        Payload<N> payload;
+
+        bool operator<(const Entry& rhs) const {
+            return key < rhs.key;
+        }
+    };
+}
+
+TEMPLATE_TEST_CASE_SIG("push then pop everything, AoS vs SoA", "[!benchmark][key_value_binary_heap]",
+        ((size_t N), N), 8, 32, 64, 128, 256) {
+    const std::vector<int> keys = randomValues(100000);
+
+    BENCHMARK("BinaryHeap<Entry>") {
+        BinaryHeap<Entry<N>> heap;
+        for (int key : keys) {
+            heap.push(Entry<N>{key, {}});
+        }
+        int sum = 0;
+        while (!heap.empty()) {
+            sum += heap.peek().key;
+            heap.pop();
+        }
+        return sum;
+    };
+
+    BENCHMARK("KeyValueBinaryHeap<int, Payload>") {
+        KeyValueBinaryHeap<int, Payload<N>> heap;
+        for (int key : keys) {
+            heap.push(key, Payload<N>{});
+        }
+        int sum = 0;
+        while (!heap.empty()) {
+            sum += heap.peekKey();
+            heap.pop();
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,88 @@
+#include "binary_heap.hpp"
+#include "fibonacci_heap.hpp"
+#include "catch2/catch.hpp"
+#include "bench_util.hpp"
+#include <memory_resource>
+
+namespace {
+    const size_t elementCount = 10000;
+
+    template <class Heap>
+    long long drainChecked(Heap& heap) {
+        long long sum = 0;
+        while (!heap.empty()) {
+            sum += heap.peek();
+            heap.pop();
+        }
+        return sum;
+    }
+
+    template <class Heap>
+    long long drainTryPop(Heap& heap) {
+        long long sum = 0;
+        while (auto top = heap.tryPop()) {
+            sum += *top;
+        }
+        return sum;
+    }
+
+    template <class Heap>
+    long long drainUnchecked(Heap& heap) {
+        long long sum = 0;
+        while (const int* top = heap.tryPeek()) {
+            sum += *top;
+            heap.popUnchecked();
+        }
+        return sum;
+    }
+
+    // Every run drains its own pre-built heap, so only the pop loop is measured.
+    template <class Heap, class Drain>
+    void benchmarkDrain(Catch::Benchmark::Chronometer meter, std::pmr::memory_resource* resource, Drain drain) {
+        static const std::vector<int> values = randomValues(elementCount);
+        std::vector<Heap> heaps;
+        heaps.reserve(meter.runs());
+        for (int run = 0; run < meter.runs(); ++run) {
+            heaps.emplace_back(resource);
+            for (int value : values) {
+                heaps.back().push(value);
+            }
+        }
+        meter.measure([&](int run) { return drain(heaps[run]); });
+    }
+}
+
+TEST_CASE("checked versus non-throwing pop loops", "[!benchmark][binary_heap][fibonacci_heap]") {
+    typedef pmr::BinaryHeap<int> Binary;
+    typedef pmr::FibonacciHeap<int> Fibonacci;
+
+    BENCHMARK_ADVANCED("BinaryHeap peek/pop")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Binary>(meter, &arena, [](Binary& heap) { return drainChecked(heap); });
+    };
+
+    BENCHMARK_ADVANCED("BinaryHeap tryPop")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Binary>(meter, &arena, [](Binary& heap) { return drainTryPop(heap); });
+    };
+
+    BENCHMARK_ADVANCED("BinaryHeap tryPeek/popUnchecked")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Binary>(meter, &arena, [](Binary& heap) { return drainUnchecked(heap); });
+    };
+
+    BENCHMARK_ADVANCED("FibonacciHeap peek/pop")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Fibonacci>(meter, &arena, [](Fibonacci& heap) { return drainChecked(heap); });
+    };
+
+    BENCHMARK_ADVANCED("FibonacciHeap tryPop")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Fibonacci>(meter, &arena, [](Fibonacci& heap) { return drainTryPop(heap); });
+    };
+
+    BENCHMARK_ADVANCED("FibonacciHeap tryPeek/popUnchecked")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkDrain<Fibonacci>(meter, &arena, [](Fibonacci& heap) { return drainUnchecked(heap); });
+    };
+}
@@ -0,0 +1,38 @@
+#include "binary_heap.hpp"
+#include "static_binary_heap.hpp"
+#include "catch2/catch.hpp"
+#include "bench_util.hpp"
+
+namespace {
+    const int requestCount = 1000;
+
+    // A request builds a small queue, drains it and drops it.
+    template <class Heap>
+    long long serveRequests(const std::vector<int>& values) {
+        long long sum = 0;
+        for (int request = 0; request < requestCount; ++request) {
+            Heap heap;
+            for (int value : values) {
+                heap.push(value);
+            }
+            while (const int* top = heap.tryPeek()) {
+                sum += *top;
+                heap.popUnchecked();
+            }
+        }
+        return sum;
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG("per-request queues of small size", "[!benchmark][static_binary_heap]",
+        ((size_t N), N), 16, 64, 256) {
+    const std::vector<int> values = randomValues(N);
+
+    BENCHMARK("BinaryHeap") {
+        return serveRequests<BinaryHeap<int>>(values);
+    };
+
+    BENCHMARK("StaticBinaryHeap") {
+        return serveRequests<StaticBinaryHeap<int, N>>(values);
+    };
+}
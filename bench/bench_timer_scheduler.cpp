@@ -0,0 +1,140 @@
+#include "timer_scheduler.hpp"
+#include "binary_heap.hpp"
+#include "fibonacci_heap.hpp"
+#include "catch2/catch.hpp"
+#include <memory_resource>
+#include <random>
+
+namespace {
+    const uint64_t tickCount = 2000;
+    const int timersPerTick = 100;
+    const int cancelledPercent = 90;
+    const int farPercent = 5;
+    const uint64_t farTimeout = uint64_t{1} << 24;     // beyond the timing wheel, kept in the scheduler's far heap
+
+    // every timer is due by then
+    const uint64_t lastTick = tickCount + 2 * farTimeout;
+
+    // Network timeouts: each tick schedules a batch of 1-30s timeouts (1 tick = 1ms), most of which get cancelled
+    // a few ticks later when their request completes, and expires whatever is due. A few are long lived timers
+    // (4.5-9 hours) that are only reached by a final jump in time to lastTick.
+    struct Workload {
+        std::vector<uint64_t> deadlines;
+        std::vector<bool> cancelled;
+
+        Workload() {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<uint64_t> timeout(1000, 30000);
+            std::uniform_int_distribution<uint64_t> farTimeouts(farTimeout, 2 * farTimeout - 1);
+            std::uniform_int_distribution<int> percent(0, 99);
+            for (uint64_t tick = 0; tick < tickCount; ++tick) {
+                for (int i = 0; i < timersPerTick; ++i) {
+                    deadlines.push_back(tick + (percent(gen) < farPercent ? farTimeouts(gen) : timeout(gen)));
+                    cancelled.push_back(percent(gen) < cancelledPercent);
+                }
+            }
+        }
+    };
+
+    const uint64_t cancelDelay = 5;
+
+    struct HeapTimer {
+        uint64_t deadline;
+        uint32_t id;
+
+        bool operator<(const HeapTimer& rhs) const {
+            return deadline < rhs.deadline;
+        }
+    };
+
+    // Using a heap directly: cancelled timers stay in the heap as tombstones and are skipped when they come out.
+    template <class Heap>
+    size_t runOnHeap(const Workload& workload, Heap& heap) {
+        std::vector<bool> tombstone(workload.deadlines.size(), false);
+        size_t fired = 0;
+        auto expireUntil = [&](uint64_t tick) {
+            while (const HeapTimer* top = heap.tryPeek()) {
+                if (top->deadline > tick) {
+                    break;
+                }
+                fired += !tombstone[top->id];
+                heap.popUnchecked();
+            }
+        };
+
+        uint32_t id = 0;
+        for (uint64_t tick = 0; tick < tickCount + 30000; ++tick) {
+            if (tick < tickCount) {
+                for (int i = 0; i < timersPerTick; ++i, ++id) {
+                    heap.push(HeapTimer{workload.deadlines[id], id});
+                }
+            }
+            if (tick >= cancelDelay && tick - cancelDelay < tickCount) {
+                uint32_t first = static_cast<uint32_t>((tick - cancelDelay) * timersPerTick);
+                for (uint32_t cancel = first; cancel < first + timersPerTick; ++cancel) {
+                    if (workload.cancelled[cancel]) {
+                        tombstone[cancel] = true;
+                    }
+                }
+            }
+            expireUntil(tick);
+        }
+        expireUntil(lastTick);
+        return fired;
+    }
+
+    template <class Scheduler>
+    size_t runOnScheduler(const Workload& workload) {
+        Scheduler scheduler;
+        std::vector<typename Scheduler::Handle> handles;
+        handles.reserve(workload.deadlines.size());
+        size_t fired = 0;
+        uint32_t id = 0;
+        for (uint64_t tick = 0; tick < tickCount + 30000; ++tick) {
+            if (tick < tickCount) {
+                for (int i = 0; i < timersPerTick; ++i, ++id) {
+                    handles.push_back(scheduler.schedule(workload.deadlines[id], id));
+                }
+            }
+            if (tick >= cancelDelay && tick - cancelDelay < tickCount) {
+                uint32_t first = static_cast<uint32_t>((tick - cancelDelay) * timersPerTick);
+                for (uint32_t cancel = first; cancel < first + timersPerTick; ++cancel) {
+                    if (workload.cancelled[cancel]) {
+                        scheduler.cancel(handles[cancel]);
+                    }
+                }
+            }
+            fired += scheduler.expireUntil(tick, [](uint32_t) {});
+        }
+        fired += scheduler.expireUntil(lastTick, [](uint32_t) {});
+        return fired;
+    }
+}
+
+TEST_CASE("schedule, cancel and expire timeouts", "[!benchmark][timer_scheduler]") {
+    const Workload workload;
+
+    BinaryHeap<HeapTimer> binaryHeap;
+    size_t expected = runOnHeap(workload, binaryHeap);
+    REQUIRE( runOnScheduler<TimerScheduler<uint32_t>>(workload) == expected );
+    REQUIRE( runOnScheduler<TimerScheduler<uint32_t, FibonacciHeap>>(workload) == expected );
+
+    BENCHMARK("BinaryHeap with tombstones") {
+        BinaryHeap<HeapTimer> heap;
+        return runOnHeap(workload, heap);
+    };
+
+    BENCHMARK("FibonacciHeap with tombstones") {
+        std::pmr::monotonic_buffer_resource arena;
+        pmr::FibonacciHeap<HeapTimer> heap(&arena);
+        return runOnHeap(workload, heap);
+    };
+
+    BENCHMARK("TimerScheduler, BinaryHeap for far timers") {
+        return runOnScheduler<TimerScheduler<uint32_t>>(workload);
+    };
+
+    BENCHMARK("TimerScheduler, FibonacciHeap for far timers") {
+        return runOnScheduler<TimerScheduler<uint32_t, FibonacciHeap>>(workload);
+    };
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// Uniformly distributed ints from a fixed seed, so every run and every benchmark works on the same input.
+inline std::vector<int> randomValues(size_t count) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist;
+    std::vector<int> values(count);
+    for (auto& value : values) {
+        value = dist(gen);
+    }
+    return values;
+}
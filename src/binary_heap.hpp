@@ -4,79 +4,173 @@
 #include <functional>
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <type_traits>
+#include <optional>
+#include <cassert>
+#include <memory>
+#include <memory_resource>
 
-template<class T, typename Comparator = std::less<T>>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "binary_heap_sift.hpp"
+#include "nothrow_compare.hpp"
+#include "mapped_file.hpp"
+
+template<class T, typename Comparator = std::less<T>, typename Allocator = std::allocator<T>>
 class BinaryHeap {
 private:
-    typedef std::vector<T> Container;
+    typedef std::vector<T, Allocator> Container;
+
+    /* Snapshot file layout: this header, padding up to dataOffset, then the heap array exactly as it is laid out
+     * in memory. The comparator is not recorded, a snapshot must be mapped back with the one it was saved with.
+     */
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t elementSize;
+        uint64_t elementCount;
+        uint64_t dataOffset;
+    };
+
+    static constexpr char snapshotMagic[8] = {'W', 'S', 'B', 'H', 'E', 'A', 'P', '\0'};
+    static constexpr uint32_t snapshotVersion = 1;
+    static constexpr uint64_t snapshotDataOffset = 64;
 
     Container container;
     Comparator compare;
 
+    // when a snapshot is mapped, the elements live in the file image instead of the container
+    MappedFile mapping;
+    T* mappedData = nullptr;
+    size_t mappedSize = 0;
+
     using ConstReference = typename Container::const_reference;
 
-    inline size_t calcParentIndex(size_t childIndex) {
-        return (childIndex-1)/2;
+    inline T* elements() {
+        return mapping.isMapped() ? mappedData : container.data();
     }
 
-    inline size_t calcChildrenIndex(size_t parentIndex) {
-        return parentIndex*2+1;
+    inline const T* elements() const {
+        return mapping.isMapped() ? mappedData : container.data();
+    }
+
+    inline size_t elementCount() const {
+        return mapping.isMapped() ? mappedSize : container.size();
     }
 
     void bubbleUp(size_t index) {
-        size_t childIndex = index;
-        size_t parentIndex = calcParentIndex(childIndex);
-        while (childIndex != 0 && compare(container[childIndex], container[parentIndex])) {
-            std::swap(container[parentIndex], container[childIndex]);
-            childIndex = parentIndex;
-            parentIndex = calcParentIndex(childIndex);
-        }
-    }
-
-    void bubbleDown() {
-        unsigned long parentIndex = 0;
-        unsigned long childrenIndex = calcChildrenIndex(parentIndex);
-
-        size_t containerSize = container.size();
-        bool swapped;
-        do {
-            unsigned long minIndex = parentIndex;
-            if (childrenIndex < containerSize) {
-                minIndex = childrenIndex;
-
-                if (childrenIndex+1 < containerSize) {
-                    if (compare(container[childrenIndex+1],container[minIndex])) {
-                        minIndex = childrenIndex+1;
-                    }
+        detail::bubbleUp(elements(), index, compare);
+    }
+
+    void bubbleDown(size_t index = 0) {
+        detail::bubbleDown(elements(), elementCount(), index, compare);
+    }
+
+    inline T& unsafePeek() {
+        return elements()[0];
+    }
+
+    inline const T& unsafePeek() const {
+        return elements()[0];
+    }
+
+    // Copies a mapped snapshot into the container and drops the mapping.
+    void detach() {
+        if (mapping.isMapped()) {
+            container.assign(mappedData, mappedData + mappedSize);
+            mapping.reset();
+            mappedData = nullptr;
+            mappedSize = 0;
+        }
+    }
+
+    // Writes all bytes to fd, resuming after partial writes and interrupted calls.
+    static bool writeAll(int fd, const void* data, size_t bytes) {
+        const char* next = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t count = ::write(fd, next, bytes);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
+                return false;
             }
+            next += count;
+            bytes -= static_cast<size_t>(count);
+        }
+        return true;
+    }
 
-            if (compare(container[minIndex],container[parentIndex])) {
-                std::swap(container[parentIndex], container[minIndex]);
-                swapped = true;
-                parentIndex = minIndex;
-                childrenIndex = parentIndex*2+1;
-            } else {
-                swapped = false;
-            }
+    // Syncs the directory holding path, so a file renamed into it survives a crash.
+    static void syncParentDirectory(const std::string& path) {
+        size_t separator = path.find_last_of('/');
+        std::string directory = separator == std::string::npos ? "." : path.substr(0, separator == 0 ? 1 : separator);
 
-        } while (swapped);
+        int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0) {
+            throw std::runtime_error("save: Cannot open directory '" + directory + "'.");
+        }
+        bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        if (!synced) {
+            throw std::runtime_error("save: Cannot sync directory '" + directory + "'.");
+        }
     }
 
-    inline T& unsafePeek() {
-        return container[0];
+    // Elements can only be written in place if they are owned or mapped copy-on-write.
+    void makeWritable() {
+        if (mapping.isMapped() && !mapping.isWritable()) {
+            detach();
+        }
     }
 public:
     BinaryHeap() = default;
 
+    explicit BinaryHeap(const Allocator& allocator) : container(allocator) {}
+
+    // Builds the heap from a range in linear time (bottom-up heapify).
+    template<class InputIt>
+    BinaryHeap(InputIt first, InputIt last, const Allocator& allocator = Allocator()) : container(first, last, allocator) {
+        for (size_t index = container.size()/2; index > 0; --index) {
+            bubbleDown(index-1);
+        }
+    }
+
+    BinaryHeap(const BinaryHeap& other)
+        : container(other.elements(), other.elements() + other.elementCount(),
+                    std::allocator_traits<Allocator>::select_on_container_copy_construction(other.container.get_allocator())),
+          compare(other.compare) {}
+
+    BinaryHeap(BinaryHeap&& other) = default;
+
+    BinaryHeap& operator=(const BinaryHeap& other) {
+        if (this != &other) {
+            BinaryHeap copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    BinaryHeap& operator=(BinaryHeap&& other) = default;
+
     void push(const T &val) {
+        detach();
+
         size_t childIndex = container.size();
         container.push_back(val);
 
         bubbleUp(childIndex);
     }
 
-    ConstReference peek() {
+    ConstReference peek() const {
         if (empty()) {
             throw std::out_of_range("Heap is empty.");
         }
@@ -84,19 +178,56 @@ public:
         return unsafePeek();
     }
 
+    // Returns nullptr instead of throwing when the heap is empty.
+    const T* tryPeek() const noexcept {
+        return empty() ? nullptr : &unsafePeek();
+    }
+
     void pop() {
         if (empty()) {
             throw std::out_of_range("Heap is empty.");
         }
 
-        std::iter_swap(container.begin(), container.end()-1);
-        container.pop_back();
+        popUnchecked();
+    }
+
+    /* Pops and returns the top, or nothing when the heap is empty. It is noexcept as long as moving and comparing
+     * elements cannot throw, except for trivially copyable elements: those can be mapped from a read-only snapshot,
+     * which has to be copied into memory before it is first modified, and that copy may throw.
+     */
+    std::optional<T> tryPop() noexcept(detail::isNothrowPop<T, Comparator> && !std::is_trivially_copyable<T>::value) {
+        if (empty()) {
+            return std::nullopt;
+        }
+
+        makeWritable();
+
+        std::optional<T> top{std::move(unsafePeek())};
+        popUnchecked();
+
+        return top;
+    }
+
+    // Pop without the emptiness check, the heap must not be empty (asserted in debug builds).
+    void popUnchecked() {
+        assert(!empty() && "popUnchecked: Heap is empty.");
+
+        makeWritable();
+
+        T* heap = elements();
+        std::swap(heap[0], heap[elementCount()-1]);
+        if (mapping.isMapped()) {
+            --mappedSize;
+        } else {
+            container.pop_back();
+        }
 
         bubbleDown();
     }
 
     T pushPop(T val) {
         if (!empty() && !compare(val, unsafePeek())) {
+            makeWritable();
             std::swap(unsafePeek(), val);
             bubbleDown();
         }
@@ -109,17 +240,103 @@ public:
             throw std::out_of_range("Heap is empty.");
         }
 
+        makeWritable();
         std::swap(unsafePeek(), val);
         bubbleDown();
 
         return val;
     }
 
-    size_t size() {
-        return container.size();
+    size_t size() const {
+        return elementCount();
+    }
+
+    bool empty() const {
+        return elementCount() == 0;
+    }
+
+    /* Writes the heap array to a file, prefixed with a small versioned header. Only available for trivially
+     * copyable types, whose heap array is a valid image that mapFrom can use as is.
+     */
+    void save(const std::string& path) const {
+        static_assert(std::is_trivially_copyable<T>::value, "save: T must be trivially copyable.");
+        static_assert(alignof(T) <= snapshotDataOffset, "save: T is over-aligned for the snapshot format.");
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+        header.version = snapshotVersion;
+        header.elementSize = sizeof(T);
+        header.elementCount = elementCount();
+        header.dataOffset = snapshotDataOffset;
+
+        /* Written to a uniquely named file next to the target, synced to disk and renamed over the target. Saving a
+         * heap mapped from path never truncates the pages it is reading from, concurrent saves do not share a
+         * temporary file, and a crash or failed save leaves either the previous snapshot or the new one, complete.
+         */
+        std::string temporaryPath = path + ".XXXXXX";
+        int fd = ::mkstemp(&temporaryPath[0]);
+        if (fd < 0) {
+            throw std::runtime_error("save: Cannot create a temporary file for '" + path + "'.");
+        }
+
+        char padding[snapshotDataOffset - sizeof(header)] = {};
+        bool written = ::fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0
+                       && writeAll(fd, &header, sizeof(header))
+                       && writeAll(fd, padding, sizeof(padding))
+                       && writeAll(fd, elements(), elementCount() * sizeof(T))
+                       && ::fsync(fd) == 0;
+        if (::close(fd) != 0 || !written) {
+            ::unlink(temporaryPath.c_str());
+            throw std::runtime_error("save: Failed writing '" + temporaryPath + "'.");
+        }
+
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            ::unlink(temporaryPath.c_str());
+            throw std::runtime_error("save: Cannot replace '" + path + "'.");
+        }
+
+        syncParentDirectory(path);
     }
 
-    bool empty() {
-        return container.empty();
+    /* Replaces the contents of the heap with a snapshot written by save, using the mapped file as storage without
+     * touching the elements. A ReadOnly mapping is copied into memory on the first modification, a CopyOnWrite
+     * mapping is modified in place and only copied when the heap has to grow.
+     */
+    void mapFrom(const std::string& path, MappedFile::Mode mode = MappedFile::Mode::CopyOnWrite) {
+        static_assert(std::is_trivially_copyable<T>::value, "mapFrom: T must be trivially copyable.");
+
+        MappedFile file(path, mode);
+
+        SnapshotHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::runtime_error("mapFrom: '" + path + "' is too small to be a heap snapshot.");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, snapshotMagic, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("mapFrom: '" + path + "' is not a heap snapshot.");
+        }
+        if (header.version != snapshotVersion) {
+            throw std::runtime_error("mapFrom: '" + path + "' has an unsupported snapshot version.");
+        }
+        if (header.elementSize != sizeof(T)) {
+            throw std::runtime_error("mapFrom: '" + path + "' was saved with a different element type.");
+        }
+        if (header.dataOffset % alignof(T) != 0
+                || header.dataOffset > file.size()
+                || header.elementCount > (file.size() - header.dataOffset) / sizeof(T)) {
+            throw std::runtime_error("mapFrom: '" + path + "' is truncated or corrupt.");
+        }
+
+        container.clear();
+        container.shrink_to_fit();
+        mappedData = reinterpret_cast<T*>(file.data() + header.dataOffset);
+        mappedSize = header.elementCount;
+        mapping = std::move(file);
     }
 };
+
+namespace pmr {
+    template<class T, typename Comparator = std::less<T>>
+    using BinaryHeap = ::BinaryHeap<T, Comparator, std::pmr::polymorphic_allocator<T>>;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+/* Sift routines shared by the array backed binary heaps (BinaryHeap and StaticBinaryHeap), KeyValueBinaryHeap reuses
+ * the index helpers.
+ * They work on any random access storage and move a hole along the path instead of swapping, so the element being
+ * sifted is written once at the end. All of them are constexpr so fixed-size heaps can be used at compile time.
+ */
+namespace detail {
+    constexpr size_t calcParentIndex(size_t childIndex) {
+        return (childIndex-1)/2;
+    }
+
+    constexpr size_t calcChildrenIndex(size_t parentIndex) {
+        return parentIndex*2+1;
+    }
+
+    template <class RandomIt, class Comparator>
+    constexpr void bubbleUp(RandomIt heap, size_t index, Comparator& compare) {
+        typename std::iterator_traits<RandomIt>::value_type value = std::move(heap[index]);
+
+        size_t childIndex = index;
+        while (childIndex != 0) {
+            size_t parentIndex = calcParentIndex(childIndex);
+            if (!compare(value, heap[parentIndex])) {
+                break;
+            }
+            heap[childIndex] = std::move(heap[parentIndex]);
+            childIndex = parentIndex;
+        }
+
+        heap[childIndex] = std::move(value);
+    }
+
+    template <class RandomIt, class Comparator>
+    constexpr void bubbleDown(RandomIt heap, size_t size, size_t index, Comparator& compare) {
+        if (index >= size) {
+            return;
+        }
+
+        typename std::iterator_traits<RandomIt>::value_type value = std::move(heap[index]);
+
+        size_t parentIndex = index;
+        size_t childrenIndex = calcChildrenIndex(parentIndex);
+        while (childrenIndex < size) {
+            size_t minIndex = childrenIndex;
+            if (childrenIndex+1 < size && compare(heap[childrenIndex+1], heap[minIndex])) {
+                minIndex = childrenIndex+1;
+            }
+
+            if (!compare(heap[minIndex], value)) {
+                break;
+            }
+
+            heap[parentIndex] = std::move(heap[minIndex]);
+            parentIndex = minIndex;
+            childrenIndex = calcChildrenIndex(parentIndex);
+        }
+
+        heap[parentIndex] = std::move(value);
+    }
+}
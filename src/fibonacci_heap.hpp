@@ -4,15 +4,28 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <cmath>
+#include <array>
+#include <optional>
+#include <cassert>
+#include <type_traits>
+#include <utility>
 
-template <typename T, typename Comparator = std::less<T>>
+#include "nothrow_compare.hpp"
+
+template <typename T, typename Comparator = std::less<T>, typename Allocator = std::allocator<T>>
 class FibonacciHeap {
     struct Node;
 public:
     typedef std::shared_ptr<Node> NodeHandle;
 private:
+    // nodes (together with their shared_ptr control blocks) come from the rebound allocator
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node> NodeAllocator;
+
+    // the degree of any node is bounded by log_phi(n), which stays below this for any n that fits in a size_t
+    static constexpr size_t maxDegree = 96;
 
     struct Node {
         T value;
@@ -38,8 +51,8 @@ private:
             ++degree;
         }
 
-        void removeChild(NodeHandle& child) {
-            link(child->prevSibling, child->nextSibling);
+        void removeChild(const NodeHandle& child) {
+            linkNodes(child->prevSibling, child->nextSibling);
 
             if (child == firstChild) {
                 // if we are removing the first child, set the next sibling as new first child
@@ -63,29 +76,39 @@ private:
     NodeHandle listHead;
     NodeHandle minimumValueNode;
     Comparator compare;
+    NodeAllocator nodeAllocator;
     size_t m_size;
 
-    void cutNode(NodeHandle& node) {
+    void cutNode(NodeHandle node) {
+        // node is taken by value, it may alias a link (e.g. firstChild) that is rewritten while cutting
         NodeHandle parent = node->parent;
 
-        // cut node from parent
-        node->parent.reset();
+        // cut node from parent and make it a root
+        parent->removeChild(node);
+        makeNodeRoot(node);
+
+        // roots are never marked, so the cascade stops once it reaches one
+        if (parent->parent) {
+            bool parentMarked = parent->marked;
+            parent->marked = true;
+            if (parentMarked) {
+                //if previously marked cut it as well
+                cutNode(parent);
+            }
+        }
+    }
 
-        // make it a root
-        linkNodes(listHead->prevSibling, node);
-        linkNodes(node, listHead);
-        node->marked = false;
+    static constexpr size_t prefetchDistance = 4;
 
-        // mark parent
-        bool parentMarked = parent->marked;
-        parent->marked = true;
-        if (parentMarked) {
-            //if previously marked cut it as well
-            cutNode(parent);
-        }
+    static inline void prefetch(const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
     }
 
-    void makeNodeRoot(NodeHandle& node) {
+    void makeNodeRoot(const NodeHandle& node) {
         linkNodes(listHead->prevSibling, node);
         linkNodes(node, listHead);
         node->parent.reset();
@@ -95,23 +118,78 @@ private:
 public:
     FibonacciHeap() : m_size{0} {}
 
-    size_t size() { return m_size; }
+    explicit FibonacciHeap(const Allocator& allocator) : nodeAllocator(allocator), m_size{0} {}
+
+    // copies would share their nodes, only moving is supported
+    FibonacciHeap(const FibonacciHeap&) = delete;
+    FibonacciHeap& operator=(const FibonacciHeap&) = delete;
+
+    FibonacciHeap(FibonacciHeap&& other) noexcept
+        : listHead(std::move(other.listHead)),
+          minimumValueNode(std::move(other.minimumValueNode)),
+          compare(std::move(other.compare)),
+          nodeAllocator(other.nodeAllocator),
+          m_size(std::exchange(other.m_size, 0)) {}
+
+    // the allocator is not reassigned, every node is released through the allocator it was created with
+    FibonacciHeap& operator=(FibonacciHeap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            listHead = std::move(other.listHead);
+            minimumValueNode = std::move(other.minimumValueNode);
+            compare = std::move(other.compare);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~FibonacciHeap() { clear(); }
 
-    bool empty() { return m_size == 0; }
+    /* Removes every element. Sibling rings and parent links are cycles of shared_ptr, so they are broken node by node,
+     * splicing the children of each visited node into the list of nodes still to visit. It does not allocate or
+     * recurse, whatever the shape of the trees. Handles still held by the caller stay valid but are detached.
+     */
+    void clear() noexcept {
+        if (!listHead) {
+            return;
+        }
+
+        minimumValueNode.reset();
+        listHead->prevSibling->nextSibling.reset();
+        NodeHandle current = std::move(listHead);
+        while (current) {
+            if (current->firstChild) {
+                NodeHandle& lastChild = current->firstChild->prevSibling;
+                lastChild->nextSibling = std::move(current->nextSibling);
+                current->nextSibling = std::move(current->firstChild);
+            }
+
+            NodeHandle next = std::move(current->nextSibling);
+            current->prevSibling.reset();
+            current->parent.reset();
+            current->degree = 0;
+            current = std::move(next);
+        }
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+
+    bool empty() const { return m_size == 0; }
 
     NodeHandle push(T value) {
         /* Operation insert works by creating a new heap with one element and doing merge.
          * This takes constant time, and the potential increases by one, because the number of trees increases.
          * The amortized cost is thus still constant.*/
         if (m_size == 0) {
-            listHead = std::make_shared<Node>(value);
+            listHead = std::allocate_shared<Node>(nodeAllocator, value);
             minimumValueNode = listHead;
             linkNodes(listHead, listHead);
             ++m_size;
             return minimumValueNode;
         }
 
-        NodeHandle newNode = std::make_shared<Node>(value);
+        NodeHandle newNode = std::allocate_shared<Node>(nodeAllocator, value);
         linkNodes(listHead->prevSibling, newNode);
         linkNodes(newNode, listHead);
         ++m_size;
@@ -122,7 +200,7 @@ public:
 
         return newNode;
     }
-    const T& peek() {
+    const T& peek() const {
         /* Operation find minimum is now trivial because we keep the pointer to the node containing it. 
          * It does not change the potential of the heap, therefore both actual and amortized cost are constant.*/
         if (empty()) {
@@ -132,8 +210,34 @@ public:
         return minimumValueNode->value;
     }
 
+    // Returns nullptr instead of throwing when the heap is empty.
+    const T* tryPeek() const noexcept {
+        return empty() ? nullptr : &minimumValueNode->value;
+    }
+
     void pop() {
         if (empty()) throw std::out_of_range("Heap is empty.");
+        popUnchecked();
+    }
+
+    /* Pops and returns the minimum, or nothing when the heap is empty. The value is moved out of the popped node.
+     * Popping does not allocate, so it is noexcept as long as moving and comparing elements cannot throw.
+     */
+    std::optional<T> tryPop() noexcept(std::is_nothrow_move_constructible<T>::value
+                                       && detail::isNothrowComparator<Comparator, T>::value) {
+        if (empty()) {
+            return std::nullopt;
+        }
+
+        std::optional<T> top{std::move(minimumValueNode->value)};
+        popUnchecked();
+
+        return top;
+    }
+
+    // Pop without the emptiness check, the heap must not be empty (asserted in debug builds). It does not allocate.
+    void popUnchecked() {
+        assert(!empty() && "popUnchecked: Heap is empty.");
         /* Operation extract minimum (same as delete minimum) operates in three phases.
          * First we take the root containing the minimum element and remove it. 
          * Its children will become roots of new trees. 
@@ -154,6 +258,11 @@ public:
             listHead = minimumValueNode->nextSibling;
         }
 
+        // drop the links of the removed node, the last node of the heap is linked to itself and would never be freed
+        minimumValueNode->nextSibling.reset();
+        minimumValueNode->prevSibling.reset();
+        minimumValueNode->firstChild.reset();
+        minimumValueNode->degree = 0;
         minimumValueNode.reset();
         --m_size;
 
@@ -173,8 +282,7 @@ public:
          */
 
         // reduce number of nodes
-        size_t size =  std::log2(m_size) + 1;
-        std::vector<NodeHandle> degrees{size};
+        std::array<NodeHandle, maxDegree> degrees;
         bool check = true;
         while (check) {
             check = false;
@@ -204,6 +312,7 @@ public:
                     linkNodes(bigger->prevSibling, bigger->nextSibling); // unlink bigger from list
                     smaller->addChild(bigger); // add it to children of smaller
                     bigger->parent = smaller; // set the parent of bigger
+                    bigger->marked = false; // it has not lost any child since becoming a child of smaller
 
                     degrees[degree].reset(); // reset the value in the vector as the node's degree has been updated
 
@@ -261,4 +370,58 @@ public:
         node->value = newValue;
         decreaseKey(node);
     }
+
+    /* Applies a batch of (handle, newValue) updates, as produced e.g. when relaxing all edges of a vertex.
+     * All new keys are written first, so a node that appears several times keeps the lowest of its values and is
+     * cut at most once. Cuts are then done against the final keys, and the minimum is updated in a single pass at
+     * the end. The batch is validated before anything is modified, that first pass over the nodes prefetches the
+     * upcoming nodes and the parents of the visited ones, so the later passes find them in cache.
+     */
+    template <class ForwardIt>
+    void decreaseKeys(ForwardIt first, ForwardIt last) {
+        ForwardIt ahead = first;
+        for (size_t i = 0; i < prefetchDistance && ahead != last; ++i) {
+            prefetch(ahead->first.get());
+            ++ahead;
+        }
+        for (ForwardIt it = first; it != last; ++it) {
+            if (ahead != last) {
+                prefetch(ahead->first.get());
+                ++ahead;
+            }
+            if (compare(it->first->value, it->second)) {
+                throw std::invalid_argument("decreaseKeys: New key value is higher than alredy existing.");
+            }
+            prefetch(it->first->parent.get());
+        }
+
+        for (ForwardIt it = first; it != last; ++it) {
+            if (compare(it->second, it->first->value)) {
+                it->first->value = it->second;
+            }
+        }
+
+        for (ForwardIt it = first; it != last; ++it) {
+            const NodeHandle& node = it->first;
+            if (node->parent && compare(node->value, node->parent->value)) {
+                cutNode(node);
+            }
+        }
+
+        for (ForwardIt it = first; it != last; ++it) {
+            if (compare(it->first->value, minimumValueNode->value)) {
+                minimumValueNode = it->first;
+            }
+        }
+    }
+
+    template <class UpdateRange>
+    void decreaseKeys(const UpdateRange& updates) {
+        decreaseKeys(std::begin(updates), std::end(updates));
+    }
 };
+
+namespace pmr {
+    template <typename T, typename Comparator = std::less<T>>
+    using FibonacciHeap = ::FibonacciHeap<T, Comparator, std::pmr::polymorphic_allocator<T>>;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <optional>
+#include <memory>
+#include <memory_resource>
+
+#include "binary_heap_sift.hpp"
+
+/* Binary heap that keeps keys and payloads apart (structure of arrays).
+ * Only the dense key array and a parallel array of payload slot indices are moved around while sifting,
+ * payloads stay in their slot from push until they are popped, so big payloads are never dragged through
+ * the cache during comparisons.
+ */
+template<class Key, class Value, typename Comparator = std::less<Key>,
+         typename Allocator = std::allocator<std::pair<Key, Value>>>
+class KeyValueBinaryHeap {
+private:
+    template<class U>
+    using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+    typedef std::vector<Key, Rebind<Key>> KeyContainer;
+    typedef std::vector<size_t, Rebind<size_t>> IndexContainer;
+    // a free slot holds no payload, so whatever a popped payload owns is released right away
+    typedef std::vector<std::optional<Value>, Rebind<std::optional<Value>>> ValueContainer;
+
+    KeyContainer keys;
+    IndexContainer slots;        // slots[i] is the position in values of the payload belonging to keys[i]
+    ValueContainer values;
+    IndexContainer freeSlots;    // positions in values left behind by popped elements
+    Comparator compare;
+
+    using ConstKeyReference = typename KeyContainer::const_reference;
+    using ConstValueReference = const Value&;
+
+    // The hole-based sifts of binary_heap_sift.hpp, with the slot array following the keys.
+    void bubbleUp(size_t index) {
+        Key key = std::move(keys[index]);
+        size_t slot = slots[index];
+
+        size_t childIndex = index;
+        while (childIndex != 0) {
+            size_t parentIndex = detail::calcParentIndex(childIndex);
+            if (!compare(key, keys[parentIndex])) {
+                break;
+            }
+            keys[childIndex] = std::move(keys[parentIndex]);
+            slots[childIndex] = slots[parentIndex];
+            childIndex = parentIndex;
+        }
+
+        keys[childIndex] = std::move(key);
+        slots[childIndex] = slot;
+    }
+
+    void bubbleDown() {
+        size_t containerSize = keys.size();
+        if (containerSize == 0) {
+            return;
+        }
+
+        Key key = std::move(keys[0]);
+        size_t slot = slots[0];
+
+        size_t parentIndex = 0;
+        size_t childrenIndex = detail::calcChildrenIndex(parentIndex);
+        while (childrenIndex < containerSize) {
+            size_t minIndex = childrenIndex;
+            if (childrenIndex+1 < containerSize && compare(keys[childrenIndex+1], keys[minIndex])) {
+                minIndex = childrenIndex+1;
+            }
+
+            if (!compare(keys[minIndex], key)) {
+                break;
+            }
+
+            keys[parentIndex] = std::move(keys[minIndex]);
+            slots[parentIndex] = slots[minIndex];
+            parentIndex = minIndex;
+            childrenIndex = detail::calcChildrenIndex(parentIndex);
+        }
+
+        keys[parentIndex] = std::move(key);
+        slots[parentIndex] = slot;
+    }
+
+    template<class V>
+    size_t storeValue(V&& value) {
+        if (freeSlots.empty()) {
+            values.emplace_back(std::forward<V>(value));
+            return values.size()-1;
+        }
+
+        size_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        values[slot].emplace(std::forward<V>(value));
+        return slot;
+    }
+
+    template<class V>
+    void pushValue(const Key &key, V&& value) {
+        size_t slot = storeValue(std::forward<V>(value));
+
+        size_t childIndex = keys.size();
+        keys.push_back(key);
+        slots.push_back(slot);
+
+        bubbleUp(childIndex);
+    }
+
+    void removeTop() {
+        values[slots[0]].reset();
+        freeSlots.push_back(slots[0]);
+
+        if (keys.size() > 1) {
+            keys[0] = std::move(keys.back());
+            slots[0] = slots.back();
+        }
+        keys.pop_back();
+        slots.pop_back();
+
+        bubbleDown();
+
+        if (keys.empty()) {
+            // nothing is referenced anymore, give back the slot storage instead of keeping it around as free slots
+            values.clear();
+            freeSlots.clear();
+        }
+    }
+public:
+    KeyValueBinaryHeap() = default;
+
+    explicit KeyValueBinaryHeap(const Allocator& allocator)
+        : keys(allocator), slots(allocator), values(allocator), freeSlots(allocator) {}
+
+    void push(const Key &key, const Value &value) {
+        pushValue(key, value);
+    }
+
+    // Moves the payload into its slot, so owning or move-only payloads are never copied.
+    void push(const Key &key, Value &&value) {
+        pushValue(key, std::move(value));
+    }
+
+    ConstKeyReference peekKey() const {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        return keys[0];
+    }
+
+    ConstValueReference peekValue() const {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        return *values[slots[0]];
+    }
+
+    void pop() {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        removeTop();
+    }
+
+    // Pops the top element, moving its payload out of the heap. This is the only place a payload is moved.
+    std::pair<Key, Value> extract() {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        std::pair<Key, Value> top{std::move(keys[0]), std::move(*values[slots[0]])};
+        removeTop();
+
+        return top;
+    }
+
+    size_t size() const {
+        return keys.size();
+    }
+
+    bool empty() const {
+        return keys.empty();
+    }
+};
+
+namespace pmr {
+    template<class Key, class Value, typename Comparator = std::less<Key>>
+    using KeyValueBinaryHeap =
+        ::KeyValueBinaryHeap<Key, Value, Comparator, std::pmr::polymorphic_allocator<std::pair<Key, Value>>>;
+}
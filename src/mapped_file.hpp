@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Owning handle to a whole file mapped into memory (POSIX mmap).
+ * The file is always mapped private, so the mapping is a restore image that is never written back: CopyOnWrite maps
+ * it writable and writes land in private copies of the touched pages, ReadOnly maps it without write access.
+ */
+class MappedFile {
+public:
+    enum class Mode { ReadOnly, CopyOnWrite };
+
+private:
+    void* address = nullptr;
+    size_t length = 0;
+    bool writable = false;
+
+    static std::runtime_error error(const std::string& what, const std::string& path) {
+        return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+    }
+
+public:
+    MappedFile() = default;
+
+    MappedFile(const std::string& path, Mode mode) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw error("Cannot open", path);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw error("Cannot stat", path);
+        }
+        length = static_cast<size_t>(info.st_size);
+
+        if (length > 0) {
+            writable = mode == Mode::CopyOnWrite;
+            int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+
+            address = ::mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                address = nullptr;
+                ::close(fd);
+                throw error("Cannot map", path);
+            }
+        }
+
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : address{std::exchange(other.address, nullptr)},
+          length{std::exchange(other.length, 0)},
+          writable{std::exchange(other.writable, false)} {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            reset();
+            address = std::exchange(other.address, nullptr);
+            length = std::exchange(other.length, 0);
+            writable = std::exchange(other.writable, false);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { reset(); }
+
+    void reset() {
+        if (address) {
+            ::munmap(address, length);
+        }
+        address = nullptr;
+        length = 0;
+        writable = false;
+    }
+
+    bool isMapped() const { return address != nullptr; }
+
+    bool isWritable() const { return writable; }
+
+    size_t size() const { return length; }
+
+    char* data() { return static_cast<char*>(address); }
+
+    const char* data() const { return static_cast<const char*>(address); }
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+    // Whether comparing two T with a Comparator can throw, used to make the non-throwing heap operations noexcept.
+    template <class Comparator, class T>
+    struct isNothrowComparator : std::integral_constant<bool,
+        noexcept(std::declval<Comparator&>()(std::declval<const T&>(), std::declval<const T&>()))> {};
+
+    // the standard function objects are not declared noexcept, but only throw if the operator they call does
+    template <class T>
+    struct isNothrowComparator<std::less<T>, T>
+        : std::integral_constant<bool, noexcept(std::declval<const T&>() < std::declval<const T&>())> {};
+
+    template <class T>
+    struct isNothrowComparator<std::greater<T>, T>
+        : std::integral_constant<bool, noexcept(std::declval<const T&>() > std::declval<const T&>())> {};
+
+    // popping moves elements around and compares them, it is nothrow if all of that is
+    template <class T, class Comparator>
+    constexpr bool isNothrowPop = std::is_nothrow_move_constructible<T>::value
+        && std::is_nothrow_move_assignable<T>::value
+        && isNothrowComparator<Comparator, T>::value;
+}
@@ -2,8 +2,10 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
+#include <memory_resource>
 
-template <typename T, typename Comparator = std::less<T>>
+template <typename T, typename Comparator = std::less<T>, typename Allocator = std::allocator<T>>
 class RedBlackTree {
 public:
     RedBlackTree() = default;
@@ -14,3 +16,7 @@ public:
     void push();
 };
 
+namespace pmr {
+    template <typename T, typename Comparator = std::less<T>>
+    using RedBlackTree = ::RedBlackTree<T, Comparator, std::pmr::polymorphic_allocator<T>>;
+}
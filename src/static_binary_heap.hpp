@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <optional>
+#include <cassert>
+#include <utility>
+
+#include "binary_heap_sift.hpp"
+#include "nothrow_compare.hpp"
+
+/* Binary heap with a fixed capacity of N elements stored inline, it never allocates.
+ * Every operation is constexpr, so as long as T and Comparator are literal types the heap can be used to build
+ * tables at compile time. T must be default constructible, unused slots hold default constructed values.
+ */
+template<class T, size_t N, typename Comparator = std::less<T>>
+class StaticBinaryHeap {
+private:
+    typedef std::array<T, N> Container;
+
+    Container container{};
+    size_t m_size = 0;
+    Comparator compare{};
+
+    using ConstReference = typename Container::const_reference;
+
+    constexpr void bubbleUp(size_t index) {
+        detail::bubbleUp(container.begin(), index, compare);
+    }
+
+    constexpr void bubbleDown(size_t index = 0) {
+        detail::bubbleDown(container.begin(), m_size, index, compare);
+    }
+
+    constexpr T& unsafePeek() {
+        return container[0];
+    }
+
+    constexpr const T& unsafePeek() const {
+        return container[0];
+    }
+
+    // std::swap is only constexpr from C++20, so the top is exchanged with plain moves
+    constexpr T exchangeTop(T val) {
+        T top = std::move(unsafePeek());
+        unsafePeek() = std::move(val);
+        bubbleDown();
+
+        return top;
+    }
+public:
+    constexpr StaticBinaryHeap() = default;
+
+    constexpr void push(const T &val) {
+        if (full()) {
+            throw std::length_error("Heap is full.");
+        }
+
+        container[m_size] = val;
+        ++m_size;
+
+        bubbleUp(m_size-1);
+    }
+
+    constexpr ConstReference peek() const {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        return unsafePeek();
+    }
+
+    // Returns nullptr instead of throwing when the heap is empty.
+    constexpr const T* tryPeek() const noexcept {
+        return empty() ? nullptr : &unsafePeek();
+    }
+
+    constexpr void pop() {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        popUnchecked();
+    }
+
+    // Pops and returns the top, or nothing when the heap is empty. Noexcept if moving and comparing elements is.
+    constexpr std::optional<T> tryPop() noexcept(detail::isNothrowPop<T, Comparator>) {
+        if (empty()) {
+            return std::nullopt;
+        }
+
+        std::optional<T> top{std::move(unsafePeek())};
+        popUnchecked();
+
+        return top;
+    }
+
+    // Pop without the emptiness check, the heap must not be empty (asserted in debug builds).
+    constexpr void popUnchecked() {
+        assert(!empty() && "popUnchecked: Heap is empty.");
+
+        --m_size;
+        if (m_size != 0) {
+            container[0] = std::move(container[m_size]);
+            bubbleDown();
+        }
+    }
+
+    constexpr T pushPop(T val) {
+        if (!empty() && !compare(val, unsafePeek())) {
+            return exchangeTop(std::move(val));
+        }
+
+        return val;
+    }
+
+    constexpr T replace(T val) {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty.");
+        }
+
+        return exchangeTop(std::move(val));
+    }
+
+    constexpr size_t size() const {
+        return m_size;
+    }
+
+    constexpr bool empty() const {
+        return m_size == 0;
+    }
+
+    constexpr bool full() const {
+        return m_size == N;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+};
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <optional>
+
+#include "binary_heap.hpp"
+
+/* Timer scheduler built from a hierarchical timing wheel (https://en.wikipedia.org/wiki/Timing_wheel) for near
+ * deadlines and a heap for far ones.
+ *
+ * The wheel has 4 levels of 64 slots, level l has a resolution of 64^l ticks, so deadlines up to 2^24 ticks ahead
+ * are kept in it. Each slot is an intrusive doubly linked list of timers, which makes scheduling and cancelling a
+ * timer constant time. When time reaches the start of a slot of a higher level, its timers are cascaded down to the
+ * lower levels. Farther deadlines wait in FarHeap (BinaryHeap or FibonacciHeap) until they come within range of the
+ * wheel. Cancelling a far timer leaves a stale entry in the heap, it is dropped when it reaches the top.
+ *
+ * Timers live in a slab, a Handle is their slot in it plus a generation that changes whenever the slot is released,
+ * so a handle stays valid (and harmless) after its timer has fired or been cancelled.
+ */
+template <typename T, template <class...> class FarHeap = BinaryHeap>
+class TimerScheduler {
+public:
+    struct Handle {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+private:
+    static constexpr unsigned slotBits = 6;
+    static constexpr unsigned slotsPerLevel = 1u << slotBits;
+    static constexpr unsigned levels = 4;
+    static constexpr unsigned farShift = slotBits * levels;
+
+    // bucket ids: wheel slots first, then the list of timers being fired and the markers for far and free timers
+    static constexpr uint32_t firingBucket = levels * slotsPerLevel;
+    static constexpr uint32_t farBucket = firingBucket + 1;
+    static constexpr uint32_t freeBucket = firingBucket + 2;
+
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    static constexpr uint64_t noEvent = std::numeric_limits<uint64_t>::max();
+
+    struct Timer {
+        uint64_t deadline;
+        std::optional<T> payload;       // empty once the timer is released, so cancelled payloads are freed at once
+        uint32_t generation;
+        uint32_t bucket;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    struct FarTimer {
+        uint64_t deadline;
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator<(const FarTimer& rhs) const {
+            return deadline < rhs.deadline;
+        }
+    };
+
+    std::vector<Timer> timers;
+    std::vector<uint32_t> freeTimers;
+    std::array<uint32_t, firingBucket + 1> buckets;
+    std::array<uint64_t, levels> occupied{};     // one bit per non-empty slot of each level
+    FarHeap<FarTimer> far;
+    uint64_t current;                           // every timer with a deadline before this has fired
+    size_t pendingCount = 0;
+
+    static inline unsigned lowestSetBit(uint64_t bits) {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+        unsigned bit = 0;
+        while (!(bits & 1)) {
+            bits >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    void link(uint32_t index, uint32_t bucket) {
+        Timer& timer = timers[index];
+        timer.bucket = bucket;
+        timer.prev = none;
+        timer.next = buckets[bucket];
+        if (timer.next != none) {
+            timers[timer.next].prev = index;
+        }
+        buckets[bucket] = index;
+
+        if (bucket < firingBucket) {
+            occupied[bucket / slotsPerLevel] |= uint64_t{1} << (bucket % slotsPerLevel);
+        }
+    }
+
+    void unlink(uint32_t index) {
+        Timer& timer = timers[index];
+        if (timer.prev != none) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            buckets[timer.bucket] = timer.next;
+        }
+        if (timer.next != none) {
+            timers[timer.next].prev = timer.prev;
+        }
+
+        if (timer.bucket < firingBucket && buckets[timer.bucket] == none) {
+            occupied[timer.bucket / slotsPerLevel] &= ~(uint64_t{1} << (timer.bucket % slotsPerLevel));
+        }
+    }
+
+    // Puts a timer in the wheel level given by the highest bit in which its deadline differs from the current time.
+    void place(uint32_t index) {
+        Timer& timer = timers[index];
+        uint64_t deadline = timer.deadline < current ? current : timer.deadline;
+        uint64_t difference = deadline ^ current;
+
+        unsigned level = 0;
+        while (level < levels && (difference >> (slotBits * (level + 1))) != 0) {
+            ++level;
+        }
+
+        if (level == levels) {
+            timer.bucket = farBucket;
+            far.push(FarTimer{deadline, index, timer.generation});
+            return;
+        }
+
+        uint32_t slot = static_cast<uint32_t>((deadline >> (slotBits * level)) & (slotsPerLevel - 1));
+        link(index, level * slotsPerLevel + slot);
+    }
+
+    void release(uint32_t index) {
+        Timer& timer = timers[index];
+        ++timer.generation;
+        timer.bucket = freeBucket;
+        timer.payload.reset();
+        freeTimers.push_back(index);
+        --pendingCount;
+    }
+
+    // First tick at which a wheel slot has to be fired or cascaded, or far timers have to be moved into the wheel.
+    uint64_t nextEventTick() {
+        uint64_t next = noEvent;
+        for (unsigned level = 0; level < levels; ++level) {
+            unsigned shift = slotBits * level;
+            unsigned index = static_cast<unsigned>((current >> shift) & (slotsPerLevel - 1));
+            uint64_t pending = occupied[level] & (~uint64_t{0} << index);
+            if (pending) {
+                uint64_t blockStart = (current >> (shift + slotBits)) << (shift + slotBits);
+                uint64_t tick = blockStart + (uint64_t{lowestSetBit(pending)} << shift);
+                if (tick < next) {
+                    next = tick;
+                }
+            }
+        }
+
+        if (const FarTimer* top = far.tryPeek()) {
+            uint64_t tick = (top->deadline >> farShift) << farShift;
+            if (tick < current) {
+                tick = current;
+            }
+            if (tick < next) {
+                next = tick;
+            }
+        }
+
+        return next;
+    }
+
+    void pullFar() {
+        while (const FarTimer* top = far.tryPeek()) {
+            if ((top->deadline >> farShift) > (current >> farShift)) {
+                break;
+            }
+
+            FarTimer timer = *top;
+            far.popUnchecked();
+            if (timers[timer.index].generation == timer.generation && timers[timer.index].bucket == farBucket) {
+                place(timer.index);
+            }
+        }
+    }
+
+    // Puts timers that were moved aside for firing but not fired back into the wheel. Their deadline has passed, so
+    // they land in the slot of the current tick and fire on the next expireUntil.
+    void requeueFiring() {
+        while (buckets[firingBucket] != none) {
+            uint32_t index = buckets[firingBucket];
+            unlink(index);
+            place(index);
+        }
+    }
+
+    // Requeues whatever is left in the firing list when a callback throws out of expireUntil.
+    struct FiringGuard {
+        TimerScheduler& scheduler;
+
+        ~FiringGuard() {
+            scheduler.requeueFiring();
+        }
+    };
+
+    void cascade(uint32_t bucket) {
+        while (buckets[bucket] != none) {
+            uint32_t index = buckets[bucket];
+            unlink(index);
+            place(index);
+        }
+    }
+public:
+    explicit TimerScheduler(uint64_t start = 0) : current{start} {
+        buckets.fill(none);
+    }
+
+    // Schedules payload to fire once expireUntil reaches deadline, deadlines in the past fire on the next call.
+    Handle schedule(uint64_t deadline, T payload) {
+        uint32_t index;
+        if (freeTimers.empty()) {
+            index = static_cast<uint32_t>(timers.size());
+            timers.push_back(Timer{deadline, std::move(payload), 0, freeBucket, none, none});
+        } else {
+            index = freeTimers.back();
+            freeTimers.pop_back();
+            timers[index].deadline = deadline;
+            timers[index].payload.emplace(std::move(payload));
+        }
+
+        ++pendingCount;
+        place(index);
+
+        return Handle{index, timers[index].generation};
+    }
+
+    // Returns false if the timer already fired or was cancelled.
+    bool cancel(Handle handle) {
+        if (!pending(handle)) {
+            return false;
+        }
+
+        if (timers[handle.index].bucket != farBucket) {
+            unlink(handle.index);
+        }
+        release(handle.index);
+
+        return true;
+    }
+
+    bool pending(Handle handle) const {
+        return handle.index < timers.size()
+            && timers[handle.index].generation == handle.generation
+            && timers[handle.index].bucket != freeBucket;
+    }
+
+    /* Fires every timer with a deadline up to and including time, in deadline order, calling callback with each
+     * payload. Timers may be scheduled or cancelled from the callback. Returns the number of fired timers.
+     * If a callback throws, the timers of the same tick that have not fired yet stay pending and fire on the next call.
+     */
+    template <class Callback>
+    size_t expireUntil(uint64_t time, Callback&& callback) {
+        FiringGuard guard{*this};
+        size_t fired = 0;
+        while (true) {
+            uint64_t tick = nextEventTick();
+            if (tick == noEvent || tick > time) {
+                break;
+            }
+            current = tick;
+
+            pullFar();
+            for (unsigned level = levels - 1; level > 0; --level) {
+                unsigned shift = slotBits * level;
+                if ((current & ((uint64_t{1} << shift) - 1)) == 0) {
+                    cascade(level * slotsPerLevel + static_cast<uint32_t>((current >> shift) & (slotsPerLevel - 1)));
+                }
+            }
+
+            // move the due slot aside first, so timers scheduled by the callbacks never land in the list being fired
+            uint32_t dueBucket = static_cast<uint32_t>(current & (slotsPerLevel - 1));
+            while (buckets[dueBucket] != none) {
+                uint32_t index = buckets[dueBucket];
+                unlink(index);
+                link(index, firingBucket);
+            }
+            current = tick + 1;
+
+            while (buckets[firingBucket] != none) {
+                uint32_t index = buckets[firingBucket];
+                unlink(index);
+                T payload = std::move(*timers[index].payload);
+                release(index);
+                ++fired;
+                callback(std::move(payload));
+            }
+        }
+
+        if (time >= current) {
+            current = time + 1;
+        }
+
+        return fired;
+    }
+
+    size_t size() const {
+        return pendingCount;
+    }
+
+    bool empty() const {
+        return pendingCount == 0;
+    }
+};
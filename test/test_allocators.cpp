@@ -0,0 +1,159 @@
+#include "binary_heap.hpp"
+#include "fibonacci_heap.hpp"
+#include "key_value_binary_heap.hpp"
+#include "red_black_tree.hpp"
+#include "catch2/catch.hpp"
+#include <array>
+#include <memory_resource>
+#include <type_traits>
+
+namespace {
+    // Forwards to another resource and counts what goes through it.
+    class CountingResource : public std::pmr::memory_resource {
+        std::pmr::memory_resource* upstream;
+    public:
+        size_t allocations = 0;
+        size_t deallocations = 0;
+
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream(upstream) {}
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            ++deallocations;
+            upstream->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // RedBlackTree is still a skeleton that allocates nothing, so only its allocator plumbing can be checked
+    static_assert(std::is_same<pmr::RedBlackTree<int>,
+                               RedBlackTree<int, std::less<int>, std::pmr::polymorphic_allocator<int>>>::value,
+                  "pmr::RedBlackTree uses a polymorphic allocator");
+}
+
+SCENARIO("structures allocate through the given memory resource", "[allocators]") {
+    GIVEN("a counting memory resource") {
+        CountingResource resource;
+
+        WHEN("a binary heap is used") {
+            {
+                pmr::BinaryHeap<int> heap(&resource);
+                for (int i = 0; i < 100; ++i) {
+                    heap.push(100 - i);
+                }
+                heap.pop();
+            }
+            THEN("every allocation went through the resource and was released") {
+                REQUIRE( resource.allocations > 0 );
+                REQUIRE( resource.allocations == resource.deallocations );
+            }
+        }
+
+        WHEN("a binary heap is copied") {
+            // like std::pmr containers, a copy does not propagate the resource, it uses the default one
+            CountingResource defaults;
+            std::pmr::memory_resource* previous = std::pmr::set_default_resource(&defaults);
+
+            pmr::BinaryHeap<int> heap(&resource);
+            for (int i = 0; i < 100; ++i) {
+                heap.push(100 - i);
+            }
+            size_t heapAllocations = resource.allocations;
+
+            int copyTop;
+            {
+                pmr::BinaryHeap<int> copy(heap);
+                copyTop = copy.peek();
+            }
+            std::pmr::set_default_resource(previous);
+            REQUIRE( copyTop == 1 );
+
+            THEN("the copy allocates from the default resource") {
+                REQUIRE( resource.allocations == heapAllocations );
+                REQUIRE( defaults.allocations > 0 );
+                REQUIRE( defaults.allocations == defaults.deallocations );
+            }
+        }
+
+        WHEN("a key value heap is used") {
+            {
+                pmr::KeyValueBinaryHeap<int, std::array<char, 64>> heap(&resource);
+                for (int i = 0; i < 100; ++i) {
+                    heap.push(100 - i, {});
+                }
+                heap.pop();
+            }
+            THEN("every allocation went through the resource and was released") {
+                REQUIRE( resource.allocations > 0 );
+                REQUIRE( resource.allocations == resource.deallocations );
+            }
+        }
+
+        WHEN("a fibonacci heap is used") {
+            {
+                pmr::FibonacciHeap<int> heap(&resource);
+                for (int i = 0; i < 100; ++i) {
+                    heap.push(100 - i);
+                }
+                REQUIRE( resource.allocations == 100 );
+
+                // consolidating builds trees, so nodes with children and parents are left to destroy
+                heap.pop();
+                REQUIRE( resource.allocations == 100 );
+                REQUIRE( heap.peek() == 2 );
+            }
+            THEN("every node was allocated from the resource and released") {
+                REQUIRE( resource.allocations == 100 );
+                REQUIRE( resource.allocations == resource.deallocations );
+            }
+        }
+
+        WHEN("a fibonacci heap is moved and cleared") {
+            pmr::FibonacciHeap<int> heap(&resource);
+            for (int i = 0; i < 100; ++i) {
+                heap.push(100 - i);
+            }
+            heap.pop();
+
+            pmr::FibonacciHeap<int> moved(std::move(heap));
+            REQUIRE( moved.size() == 99 );
+            REQUIRE( moved.peek() == 2 );
+            REQUIRE( resource.deallocations == 1 );
+
+            moved.clear();
+            THEN("its nodes are released") {
+                REQUIRE( moved.empty() );
+                REQUIRE( resource.allocations == resource.deallocations );
+            }
+        }
+    }
+}
+
+TEST_CASE("heaps run entirely inside a monotonic buffer", "[allocators]") {
+    std::array<std::byte, 64 * 1024> buffer;
+    CountingResource upstream(std::pmr::null_memory_resource());
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), &upstream);
+
+    pmr::BinaryHeap<int> binaryHeap(&arena);
+    pmr::FibonacciHeap<int> fibonacciHeap(&arena);
+    for (int i = 0; i < 200; ++i) {
+        binaryHeap.push(i % 17);
+        fibonacciHeap.push(i % 17);
+    }
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE( binaryHeap.peek() == fibonacciHeap.peek() );
+        binaryHeap.pop();
+        fibonacciHeap.pop();
+    }
+
+    REQUIRE( upstream.allocations == 0 );
+}
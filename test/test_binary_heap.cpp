@@ -1,6 +1,9 @@
 #include "binary_heap.hpp"
 #include "catch2/catch.hpp"
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <string>
 
 SCENARIO("binary heap changes size", "[binary_heap]") {
     GIVEN("binary heap has some items") {
@@ -189,3 +192,171 @@ SCENARIO("Push-pop and pop-push work correctly.", "[binary_heap]") {
         }
     }
 }
+
+TEST_CASE("binary heap built from a range pops in ascending order", "[binary_heap]") {
+    std::vector<int> values = {4, 2, 10, -3, 1, 7, 7, 0};
+    BinaryHeap<int> heap(values.begin(), values.end());
+
+    REQUIRE( heap.size() == values.size() );
+
+    std::vector<int> popped;
+    while (!heap.empty()) {
+        popped.push_back(heap.peek());
+        heap.pop();
+    }
+
+    std::sort(values.begin(), values.end());
+    REQUIRE( popped == values );
+}
+
+SCENARIO("binary heap snapshots can be saved and mapped back", "[binary_heap]") {
+    const std::string path = (std::filesystem::temp_directory_path() / "wiki_structs_binary_heap.snapshot").string();
+
+    GIVEN("a binary heap has been saved to a file") {
+        BinaryHeap<int> original;
+        for (int value : {4, 2, 10, -3, 1}) {
+            original.push(value);
+        }
+        original.save(path);
+
+        auto mode = GENERATE(MappedFile::Mode::ReadOnly, MappedFile::Mode::CopyOnWrite);
+
+        BinaryHeap<int> heap;
+        heap.push(100);
+        heap.mapFrom(path, mode);
+
+        WHEN("it is mapped back") {
+            THEN("it has the saved contents") {
+                REQUIRE( heap.size() == 5 );
+                REQUIRE( heap.peek() == -3 );
+            }
+        }
+
+        WHEN("the mapped heap is modified") {
+            heap.pop();
+            heap.push(-1);
+            heap.push(3);
+
+            std::vector<int> popped;
+            while (!heap.empty()) {
+                popped.push_back(heap.peek());
+                heap.pop();
+            }
+
+            THEN("it behaves like a regular heap") {
+                std::vector<int> test = {-1, 1, 2, 3, 4, 10};
+                REQUIRE( popped == test );
+            }
+
+            THEN("the file is left untouched") {
+                BinaryHeap<int> again;
+                again.mapFrom(path, mode);
+                REQUIRE( again.size() == 5 );
+                REQUIRE( again.peek() == -3 );
+            }
+        }
+
+        WHEN("the mapped heap is drained with tryPop") {
+            std::vector<int> popped;
+            while (auto top = heap.tryPop()) {
+                popped.push_back(*top);
+            }
+
+            THEN("every element comes out") {
+                std::vector<int> test = {-3, 1, 2, 4, 10};
+                REQUIRE( popped == test );
+            }
+        }
+
+        WHEN("the mapped heap is copied") {
+            BinaryHeap<int> copy(heap);
+            copy.pop();
+
+            THEN("the copy is independent") {
+                REQUIRE( copy.peek() == 1 );
+                REQUIRE( heap.peek() == -3 );
+            }
+        }
+    }
+
+    GIVEN("a heap mapped from a snapshot") {
+        BinaryHeap<int> original;
+        for (int value = 0; value < 100000; ++value) {
+            original.push(100000 - value);
+        }
+        original.save(path);
+
+        auto mode = GENERATE(MappedFile::Mode::ReadOnly, MappedFile::Mode::CopyOnWrite);
+
+        BinaryHeap<int> heap;
+        heap.mapFrom(path, mode);
+        // a copy-on-write heap is still backed by the mapping after being modified in place
+        bool modified = mode == MappedFile::Mode::CopyOnWrite;
+        if (modified) {
+            heap.pop();
+        }
+
+        WHEN("it is saved back to the same file") {
+            heap.save(path);
+
+            THEN("the file can be mapped again with the heap's contents") {
+                BinaryHeap<int> again;
+                again.mapFrom(path);
+                REQUIRE( again.size() == (modified ? 99999 : 100000) );
+                REQUIRE( again.peek() == (modified ? 2 : 1) );
+
+                // the temporary file the snapshot was written to has been renamed over it
+                const std::string prefix = std::filesystem::path(path).filename().string() + ".";
+                size_t leftovers = 0;
+                for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(path).parent_path())) {
+                    leftovers += entry.path().filename().string().rfind(prefix, 0) == 0;
+                }
+                REQUIRE( leftovers == 0 );
+            }
+        }
+    }
+
+    GIVEN("a snapshot of a different element type") {
+        BinaryHeap<long long> other;
+        other.push(1);
+        other.save(path);
+
+        THEN("it cannot be mapped") {
+            BinaryHeap<int> heap;
+            REQUIRE_THROWS_AS( heap.mapFrom(path), std::runtime_error );
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("binary heap non-throwing accessors", "[binary_heap]") {
+    BinaryHeap<int> heap;
+
+    struct PlainLess {
+        bool operator()(const std::string& lhs, const std::string& rhs) const { return lhs < rhs; }
+    };
+    static_assert(noexcept(std::declval<BinaryHeap<std::string>&>().tryPop()),
+                  "tryPop is noexcept for nothrow elements and comparators");
+    static_assert(!noexcept(std::declval<BinaryHeap<std::string, PlainLess>&>().tryPop()),
+                  "tryPop can throw if the comparator can");
+    static_assert(!noexcept(heap.tryPop()), "tryPop can throw if the heap may have to copy a read-only snapshot");
+
+    REQUIRE( heap.tryPeek() == nullptr );
+    REQUIRE_FALSE( heap.tryPop().has_value() );
+
+    heap.push(3);
+    heap.push(1);
+    heap.push(2);
+
+    const BinaryHeap<int>& view = heap;
+    REQUIRE( view.size() == 3 );
+    REQUIRE_FALSE( view.empty() );
+    REQUIRE( view.peek() == 1 );
+    REQUIRE( *view.tryPeek() == 1 );
+
+    REQUIRE( heap.tryPop() == std::optional<int>(1) );
+    heap.popUnchecked();
+    REQUIRE( heap.tryPop() == std::optional<int>(3) );
+    REQUIRE( heap.empty() );
+}
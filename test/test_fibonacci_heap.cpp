@@ -2,6 +2,8 @@
 #include "catch2/catch.hpp"
 #include <iostream>
 #include <typeinfo>
+#include <map>
+#include <random>
 
 SCENARIO("heap has correct size", "[fibonacci_heap]") {
     GIVEN("binary heap has some items") {
@@ -195,3 +197,126 @@ TEST_CASE("can't decrease key to higher value", "[fibonacci_heap]") {
         REQUIRE(true);
     }
 }
+
+TEST_CASE("batched decrease key updates values, collapses repeats and finds the new minimum", "[fibonacci_heap]") {
+    FibonacciHeap<int> heap;
+    std::vector<FibonacciHeap<int>::NodeHandle> handles;
+    for (int value : {10, 20, 30, 40, 50, 60, 70}) {
+        handles.push_back(heap.push(value));
+    }
+    // pop once so the remaining nodes get consolidated into trees
+    heap.pop();
+
+    std::vector<std::pair<FibonacciHeap<int>::NodeHandle, int>> updates = {
+        {handles[6], 35},
+        {handles[3], 5},
+        {handles[6], 1},
+        {handles[6], 25},
+    };
+    heap.decreaseKeys(updates);
+
+    std::vector<int> popped;
+    while (!heap.empty()) {
+        popped.push_back(heap.peek());
+        heap.pop();
+    }
+
+    std::vector<int> test = {1, 5, 20, 30, 50, 60};
+    REQUIRE( popped == test );
+}
+
+TEST_CASE("batched decrease key rejects the whole batch if one key would increase", "[fibonacci_heap]") {
+    FibonacciHeap<int> heap;
+    auto low = heap.push(1);
+    auto high = heap.push(10);
+
+    std::vector<std::pair<FibonacciHeap<int>::NodeHandle, int>> updates = {{high, 0}, {low, 2}};
+    REQUIRE_THROWS_AS( heap.decreaseKeys(updates), std::invalid_argument );
+    REQUIRE( heap.peek() == 1 );
+}
+
+TEST_CASE("decrease key keeps the heap consistent under random workloads", "[fibonacci_heap]") {
+    bool batched = GENERATE(false, true);
+
+    std::mt19937 gen(7);
+    FibonacciHeap<long> heap;
+    // values are unique (key * 1000000 + id) so the popped node can be found in the reference
+    std::map<long, FibonacciHeap<long>::NodeHandle> live;
+    long id = 0;
+
+    auto pushRandom = [&]() {
+        long value = static_cast<long>(gen() % 100000) * 1000000 + id++;
+        live[value] = heap.push(value);
+    };
+
+    for (int i = 0; i < 500; ++i) {
+        pushRandom();
+    }
+
+    for (int step = 0; step < 3000; ++step) {
+        int operation = gen() % 4;
+        if (operation == 0 && !live.empty()) {
+            REQUIRE( heap.peek() == live.begin()->first );
+            heap.pop();
+            live.erase(live.begin());
+        } else if (operation == 1) {
+            pushRandom();
+        } else if (!live.empty()) {
+            std::vector<std::pair<FibonacciHeap<long>::NodeHandle, long>> updates;
+            for (int i = 0; i < 8; ++i) {
+                auto it = live.begin();
+                std::advance(it, gen() % live.size());
+                long value = it->first - static_cast<long>(gen() % 5000) * 1000000;
+                auto handle = it->second;
+                live.erase(it);
+                live[value] = handle;
+                updates.emplace_back(handle, value);
+            }
+
+            if (batched) {
+                heap.decreaseKeys(updates);
+            } else {
+                for (auto& update : updates) {
+                    heap.decreaseKey(update.first, update.second);
+                }
+            }
+        }
+        REQUIRE( heap.size() == live.size() );
+    }
+
+    while (!live.empty()) {
+        REQUIRE( heap.peek() == live.begin()->first );
+        heap.pop();
+        live.erase(live.begin());
+    }
+    REQUIRE( heap.empty() );
+}
+
+TEST_CASE("fibonacci heap non-throwing accessors", "[fibonacci_heap]") {
+    FibonacciHeap<int> heap;
+
+    struct PlainLess {
+        bool operator()(int lhs, int rhs) const { return lhs < rhs; }
+    };
+    static_assert(noexcept(heap.tryPop()), "tryPop is noexcept for nothrow elements and comparators");
+    static_assert(!noexcept(std::declval<FibonacciHeap<int, PlainLess>&>().tryPop()),
+                  "tryPop can throw if the comparator can");
+
+    REQUIRE( heap.tryPeek() == nullptr );
+    REQUIRE_FALSE( heap.tryPop().has_value() );
+
+    heap.push(3);
+    heap.push(1);
+    heap.push(2);
+
+    const FibonacciHeap<int>& view = heap;
+    REQUIRE( view.size() == 3 );
+    REQUIRE_FALSE( view.empty() );
+    REQUIRE( view.peek() == 1 );
+    REQUIRE( *view.tryPeek() == 1 );
+
+    REQUIRE( heap.tryPop() == std::optional<int>(1) );
+    heap.popUnchecked();
+    REQUIRE( heap.tryPop() == std::optional<int>(3) );
+    REQUIRE( heap.empty() );
+}
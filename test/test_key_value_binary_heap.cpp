@@ -0,0 +1,149 @@
+#include "key_value_binary_heap.hpp"
+#include "catch2/catch.hpp"
+#include <memory>
+#include <string>
+
+SCENARIO("key value heap changes size", "[key_value_binary_heap]") {
+    GIVEN("key value heap has some items") {
+        KeyValueBinaryHeap<int, std::string> heap;
+
+        heap.push(4, "4");
+        heap.push(2, "2");
+        heap.push(10, "10");
+        heap.push(-3, "-3");
+        heap.push(1, "1");
+
+        REQUIRE( heap.size() == 5 );
+
+        WHEN("items are removed") {
+            heap.pop();
+            THEN("the size changes") {
+                REQUIRE( heap.size() == 4 );
+            }
+        }
+
+        WHEN("items are added") {
+            heap.push(6, "6");
+            THEN("the size changes") {
+                REQUIRE( heap.size() == 6 );
+            }
+        }
+    }
+}
+
+SCENARIO("key value heap sorts items and keeps payloads with their keys", "[key_value_binary_heap]") {
+    GIVEN("key value heap has some items") {
+        KeyValueBinaryHeap<int, std::string> heap;
+
+        heap.push(4, "4");
+        heap.push(2, "2");
+        heap.push(10, "10");
+        heap.push(-3, "-3");
+        heap.push(1, "1");
+
+        REQUIRE( heap.peekKey() == -3 );
+        REQUIRE( heap.peekValue() == "-3" );
+
+        WHEN("new min is added") {
+            heap.push(-4, "-4");
+            THEN("the heaps top changes") {
+                REQUIRE( heap.peekKey() == -4 );
+                REQUIRE( heap.peekValue() == "-4" );
+            }
+        }
+
+        WHEN("the top is extracted") {
+            auto top = heap.extract();
+            THEN("the key and payload are returned and the top changes") {
+                REQUIRE( top.first == -3 );
+                REQUIRE( top.second == "-3" );
+                REQUIRE( heap.peekKey() == 1 );
+                REQUIRE( heap.peekValue() == "1" );
+            }
+        }
+
+        WHEN("values are popped and pushed in between") {
+            heap.pop();
+            heap.pop();
+            heap.push(3, "3");
+            heap.push(0, "0");
+
+            std::vector<int> keys;
+            std::vector<std::string> values;
+            while (!heap.empty()) {
+                keys.push_back(heap.peekKey());
+                values.push_back(heap.peekValue());
+                heap.pop();
+            }
+            THEN("they come out in ascending order with their payloads") {
+                std::vector<int> testKeys = {0, 2, 3, 4, 10};
+                std::vector<std::string> testValues = {"0", "2", "3", "4", "10"};
+                REQUIRE( keys == testKeys );
+                REQUIRE( values == testValues );
+            }
+        }
+    }
+}
+
+TEST_CASE("Cannot peek, pop, or extract on an empty key value Heap.", "[key_value_binary_heap]") {
+    KeyValueBinaryHeap<int, std::string> heap;
+
+    REQUIRE_THROWS_AS( heap.peekKey(), std::out_of_range );
+    REQUIRE_THROWS_AS( heap.peekValue(), std::out_of_range );
+    REQUIRE_THROWS_AS( heap.pop(), std::out_of_range );
+    REQUIRE_THROWS_AS( heap.extract(), std::out_of_range );
+}
+
+TEST_CASE("key value heap uses the comparator on keys", "[key_value_binary_heap]") {
+    KeyValueBinaryHeap<int, std::string, std::greater<int>> heap;
+
+    heap.push(1, "1");
+    heap.push(7, "7");
+    heap.push(3, "3");
+
+    REQUIRE( heap.peekKey() == 7 );
+    REQUIRE( heap.peekValue() == "7" );
+}
+
+TEST_CASE("key value heap releases payloads as soon as they leave the heap", "[key_value_binary_heap]") {
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    auto third = std::make_shared<int>(3);
+
+    KeyValueBinaryHeap<int, std::shared_ptr<int>> heap;
+    heap.push(1, first);
+    heap.push(2, second);
+    heap.push(3, third);
+
+    REQUIRE( first.use_count() == 2 );
+
+    heap.pop();
+    REQUIRE( first.use_count() == 1 );
+
+    auto top = heap.extract();
+    REQUIRE( top.second == second );
+    REQUIRE( second.use_count() == 2 );
+
+    // the freed slots are reused by new payloads
+    heap.push(0, first);
+    REQUIRE( first.use_count() == 2 );
+    REQUIRE( heap.peekValue() == first );
+    REQUIRE( third.use_count() == 2 );
+}
+
+TEST_CASE("key value heap moves payloads in and out", "[key_value_binary_heap]") {
+    KeyValueBinaryHeap<int, std::unique_ptr<int>> heap;
+    heap.push(2, std::make_unique<int>(2));
+    heap.push(1, std::make_unique<int>(1));
+
+    auto payload = std::make_unique<int>(0);
+    int* address = payload.get();
+    heap.push(0, std::move(payload));
+
+    REQUIRE( heap.peekValue().get() == address );
+
+    auto top = heap.extract();
+    REQUIRE( top.first == 0 );
+    REQUIRE( top.second.get() == address );
+    REQUIRE( *heap.extract().second == 1 );
+}
@@ -0,0 +1,137 @@
+#include "static_binary_heap.hpp"
+#include "binary_heap.hpp"
+#include "catch2/catch.hpp"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+
+namespace {
+    // sorts at compile time by pushing everything into a heap and popping it back out
+    template <size_t N>
+    constexpr std::array<int, N> heapSorted(std::array<int, N> values) {
+        StaticBinaryHeap<int, N> heap;
+        for (int value : values) {
+            heap.push(value);
+        }
+        std::array<int, N> sorted{};
+        for (size_t i = 0; i < N; ++i) {
+            sorted[i] = heap.peek();
+            heap.pop();
+        }
+        return sorted;
+    }
+
+    constexpr std::array<int, 6> sortedTable = heapSorted<6>({4, 2, 10, -3, 1, 7});
+    static_assert(sortedTable[0] == -3 && sortedTable[1] == 1 && sortedTable[5] == 10, "heap sort at compile time");
+
+    constexpr int replacedTop() {
+        StaticBinaryHeap<int, 4, std::greater<int>> heap;
+        heap.push(1);
+        heap.push(5);
+        heap.push(3);
+        return heap.replace(0) * 10 + heap.peek();
+    }
+    static_assert(replacedTop() == 53, "replace at compile time");
+}
+
+SCENARIO("static binary heap sorts items", "[static_binary_heap]") {
+    GIVEN("static binary heap has some items") {
+        StaticBinaryHeap<int, 8> heap;
+
+        heap.push(4);
+        heap.push(2);
+        heap.push(10);
+        heap.push(-3);
+        heap.push(1);
+
+        REQUIRE( heap.size() == 5 );
+        REQUIRE( heap.peek() == -3 );
+
+        WHEN("push-pop and replace are used") {
+            THEN("they behave like the ones of the dynamic heap") {
+                REQUIRE( heap.pushPop(-4) == -4 );
+                REQUIRE( heap.pushPop(-2) == -3 );
+                REQUIRE( heap.replace(6) == -2 );
+                REQUIRE( heap.peek() == 1 );
+            }
+        }
+
+        WHEN("all values are popped from the heap") {
+            std::vector<int> popped;
+            while (auto top = heap.tryPop()) {
+                popped.push_back(*top);
+            }
+            THEN("they come out in ascending order") {
+                std::vector<int> test = {-3, 1, 2, 4, 10};
+                REQUIRE( popped == test );
+                REQUIRE( heap.tryPeek() == nullptr );
+            }
+        }
+    }
+}
+
+TEST_CASE("static binary heap tryPop is noexcept only for nothrow elements", "[static_binary_heap]") {
+    struct ThrowingMove {
+        int value = 0;
+        ThrowingMove() = default;
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&& other) noexcept(false) : value(other.value) {}
+        ThrowingMove& operator=(const ThrowingMove&) = default;
+        ThrowingMove& operator=(ThrowingMove&&) = default;
+        bool operator<(const ThrowingMove& rhs) const noexcept { return value < rhs.value; }
+    };
+
+    static_assert(noexcept(std::declval<StaticBinaryHeap<int, 4>&>().tryPop()), "nothrow for int");
+    static_assert(!noexcept(std::declval<StaticBinaryHeap<ThrowingMove, 4>&>().tryPop()), "can throw on move");
+
+    StaticBinaryHeap<ThrowingMove, 4> heap;
+    heap.push(ThrowingMove{});
+    REQUIRE( heap.tryPop().has_value() );
+}
+
+TEST_CASE("static binary heap has a fixed capacity", "[static_binary_heap]") {
+    StaticBinaryHeap<std::string, 2> heap;
+
+    REQUIRE( heap.capacity() == 2 );
+    REQUIRE_THROWS_AS( heap.peek(), std::out_of_range );
+    REQUIRE_THROWS_AS( heap.pop(), std::out_of_range );
+    REQUIRE_THROWS_AS( heap.replace("a"), std::out_of_range );
+
+    heap.push("b");
+    heap.push("a");
+
+    REQUIRE( heap.full() );
+    REQUIRE_THROWS_AS( heap.push("c"), std::length_error );
+    REQUIRE( heap.peek() == "a" );
+}
+
+TEST_CASE("static and dynamic binary heaps agree", "[static_binary_heap]") {
+    StaticBinaryHeap<int, 64> fixed;
+    BinaryHeap<int> dynamic;
+
+    std::mt19937 gen(11);
+    size_t largest = 0;
+    for (int step = 0; step < 5000; ++step) {
+        int value = static_cast<int>(gen() % 100);
+        // pushes are more likely than pops, so the heap grows until it reaches its capacity
+        if (!fixed.full() && gen() % 5 < 3) {
+            fixed.push(value);
+            dynamic.push(value);
+        } else if (!fixed.empty()) {
+            REQUIRE( fixed.peek() == dynamic.peek() );
+            fixed.pop();
+            dynamic.pop();
+        }
+        REQUIRE( fixed.size() == dynamic.size() );
+        largest = std::max(largest, fixed.size());
+    }
+    REQUIRE( largest == fixed.capacity() );
+
+    while (!fixed.empty()) {
+        REQUIRE( fixed.peek() == dynamic.peek() );
+        fixed.pop();
+        dynamic.pop();
+    }
+    REQUIRE( dynamic.empty() );
+}
@@ -0,0 +1,223 @@
+#include "timer_scheduler.hpp"
+#include "fibonacci_heap.hpp"
+#include "catch2/catch.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+
+SCENARIO("timer scheduler fires timers when their deadline is reached", "[timer_scheduler]") {
+    GIVEN("a scheduler with near and far timers") {
+        TimerScheduler<int> scheduler;
+
+        scheduler.schedule(5, 5);
+        scheduler.schedule(70, 70);
+        scheduler.schedule(5000, 5000);
+        scheduler.schedule(300000, 300000);
+        scheduler.schedule(40000000, 40000000);   // beyond the wheel, kept in the far heap
+
+        REQUIRE( scheduler.size() == 5 );
+
+        WHEN("time advances in steps") {
+            std::vector<int> fired;
+            auto record = [&](int value) { fired.push_back(value); };
+
+            REQUIRE( scheduler.expireUntil(4, record) == 0 );
+            REQUIRE( scheduler.expireUntil(5, record) == 1 );
+            REQUIRE( scheduler.expireUntil(4999, record) == 1 );
+            REQUIRE( scheduler.expireUntil(39999999, record) == 2 );
+            REQUIRE( scheduler.expireUntil(40000000, record) == 1 );
+
+            THEN("every timer fires once, in deadline order") {
+                std::vector<int> test = {5, 70, 5000, 300000, 40000000};
+                REQUIRE( fired == test );
+                REQUIRE( scheduler.empty() );
+            }
+        }
+
+        WHEN("time jumps past every deadline at once") {
+            std::vector<int> fired;
+            scheduler.expireUntil(1000000000, [&](int value) { fired.push_back(value); });
+
+            THEN("every timer fires in deadline order") {
+                std::vector<int> test = {5, 70, 5000, 300000, 40000000};
+                REQUIRE( fired == test );
+            }
+        }
+    }
+}
+
+SCENARIO("timer scheduler cancels timers", "[timer_scheduler]") {
+    GIVEN("a scheduler with near and far timers") {
+        TimerScheduler<int> scheduler;
+
+        auto near = scheduler.schedule(10, 10);
+        auto far = scheduler.schedule(50000000, 50000000);
+        scheduler.schedule(20, 20);
+
+        WHEN("timers are cancelled") {
+            REQUIRE( scheduler.cancel(near) );
+            REQUIRE( scheduler.cancel(far) );
+
+            THEN("they do not fire and cannot be cancelled again") {
+                std::vector<int> fired;
+                scheduler.expireUntil(100000000, [&](int value) { fired.push_back(value); });
+
+                REQUIRE( fired == std::vector<int>{20} );
+                REQUIRE_FALSE( scheduler.cancel(near) );
+                REQUIRE_FALSE( scheduler.cancel(far) );
+            }
+        }
+
+        WHEN("a timer has fired") {
+            scheduler.expireUntil(10, [](int) {});
+
+            THEN("its handle is no longer pending, even once its slot is reused") {
+                REQUIRE_FALSE( scheduler.pending(near) );
+                auto reused = scheduler.schedule(30, 30);
+                REQUIRE( reused.index == near.index );
+                REQUIRE_FALSE( scheduler.cancel(near) );
+                REQUIRE( scheduler.pending(reused) );
+            }
+        }
+    }
+}
+
+TEST_CASE("timer scheduler callbacks can schedule and cancel timers", "[timer_scheduler]") {
+    TimerScheduler<int> scheduler;
+    std::vector<int> fired;
+
+    auto victim = scheduler.schedule(10, -1);
+    scheduler.schedule(10, 1);
+    scheduler.schedule(5, 0);
+
+    scheduler.expireUntil(20, [&](int value) {
+        fired.push_back(value);
+        if (value == 0) {
+            scheduler.schedule(3, 100);     // already due, fires right after the current tick
+            scheduler.schedule(15, 15);
+            scheduler.cancel(victim);
+        }
+    });
+
+    REQUIRE( fired == std::vector<int>{0, 100, 1, 15} );
+    REQUIRE( scheduler.empty() );
+}
+
+namespace {
+    template <class Scheduler>
+    void checkAgainstReference() {
+        std::mt19937_64 gen(3);
+        Scheduler scheduler;
+        std::multimap<uint64_t, int> reference;
+        std::map<int, std::pair<typename Scheduler::Handle, uint64_t>> live;
+        std::map<int, uint64_t> deadlines;
+        uint64_t now = 0;
+        int id = 0;
+
+        for (int step = 0; step < 20000; ++step) {
+            int operation = gen() % 10;
+            if (operation < 5) {
+                // mostly near deadlines, some far beyond the wheel
+                uint64_t range = gen() % 4 == 0 ? (uint64_t{1} << 30) : 5000;
+                uint64_t deadline = now + gen() % range;
+                live[id] = {scheduler.schedule(deadline, id), deadline};
+                reference.emplace(deadline, id);
+                deadlines[id] = deadline;
+                ++id;
+            } else if (operation < 8 && !live.empty()) {
+                auto it = live.begin();
+                std::advance(it, gen() % live.size());
+                REQUIRE( scheduler.cancel(it->second.first) );
+
+                auto range = reference.equal_range(it->second.second);
+                for (auto ref = range.first; ref != range.second; ++ref) {
+                    if (ref->second == it->first) {
+                        reference.erase(ref);
+                        break;
+                    }
+                }
+                live.erase(it);
+            } else {
+                now += gen() % 3 == 0 ? gen() % (uint64_t{1} << 28) : gen() % 2000;
+
+                std::vector<int> expected;
+                while (!reference.empty() && reference.begin()->first <= now) {
+                    expected.push_back(reference.begin()->second);
+                    live.erase(reference.begin()->second);
+                    reference.erase(reference.begin());
+                }
+
+                std::vector<int> fired;
+                scheduler.expireUntil(now, [&](int value) { fired.push_back(value); });
+
+                for (size_t i = 1; i < fired.size(); ++i) {
+                    REQUIRE( deadlines[fired[i-1]] <= deadlines[fired[i]] );
+                }
+
+                // timers with equal deadlines may fire in any order
+                std::sort(expected.begin(), expected.end());
+                std::sort(fired.begin(), fired.end());
+                REQUIRE( fired == expected );
+            }
+            REQUIRE( scheduler.size() == reference.size() );
+        }
+    }
+}
+
+TEST_CASE("timer scheduler matches a reference under random workloads", "[timer_scheduler]") {
+    SECTION("with a binary heap for far timers") {
+        checkAgainstReference<TimerScheduler<int>>();
+    }
+
+    SECTION("with a fibonacci heap for far timers") {
+        checkAgainstReference<TimerScheduler<int, FibonacciHeap>>();
+    }
+}
+
+TEST_CASE("timer scheduler releases payloads of cancelled timers", "[timer_scheduler]") {
+    auto near = std::make_shared<int>(1);
+    auto far = std::make_shared<int>(2);
+
+    TimerScheduler<std::shared_ptr<int>> scheduler;
+    auto nearHandle = scheduler.schedule(10, near);
+    auto farHandle = scheduler.schedule(50000000, far);
+
+    REQUIRE( near.use_count() == 2 );
+    REQUIRE( far.use_count() == 2 );
+
+    scheduler.cancel(nearHandle);
+    scheduler.cancel(farHandle);
+
+    REQUIRE( near.use_count() == 1 );
+    REQUIRE( far.use_count() == 1 );
+}
+
+TEST_CASE("timer scheduler keeps unfired timers pending when a callback throws", "[timer_scheduler]") {
+    TimerScheduler<int> scheduler;
+    scheduler.schedule(10, 1);
+    scheduler.schedule(10, 2);
+    scheduler.schedule(10, 3);
+    scheduler.schedule(20, 4);
+
+    std::vector<int> fired;
+    auto throwOnce = [&](int value) {
+        fired.push_back(value);
+        if (fired.size() == 1) {
+            throw std::runtime_error("callback failed");
+        }
+    };
+
+    REQUIRE_THROWS_AS( scheduler.expireUntil(30, throwOnce), std::runtime_error );
+    REQUIRE( fired.size() == 1 );
+    REQUIRE( scheduler.size() == 3 );
+
+    scheduler.expireUntil(30, throwOnce);
+
+    REQUIRE( fired.size() == 4 );
+    std::vector<int> sameTick(fired.begin(), fired.begin() + 3);
+    std::sort(sameTick.begin(), sameTick.end());
+    REQUIRE( sameTick == std::vector<int>{1, 2, 3} );
+    REQUIRE( fired.back() == 4 );
+    REQUIRE( scheduler.empty() );
+}